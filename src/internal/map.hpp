@@ -27,12 +27,12 @@ public:
 };
 
 // Apply the map operation to a source.
+// At most max_queued_jobs input records are buffered in the pool at any time.
 // TODO: Pass in a thread-pool here.
 template<typename In_Type, typename Key_Type, typename Out_Type>
-void apply_map(Source<In_Type>& src, KVSink<Key_Type, Out_Type>& sink, MapFn<In_Type, Key_Type, Out_Type> map_fn) {
-  thread::Pool pool(4);
-  // TODO: Run this over multiple threads.
-  SingleThreadEmitCollector<Key_Type, In_Type> emit_collector(sink);
+void apply_map(Source<In_Type>& src, KVSink<Key_Type, Out_Type>& sink, MapFn<In_Type, Key_Type, Out_Type> map_fn, std::size_t max_queued_jobs) {
+  thread::Pool pool(4, max_queued_jobs);
+  SingleThreadEmitCollector<Key_Type, Out_Type> emit_collector(sink);
   while(src.has_next()) {
     const In_Type& value = src.next();
     pool.add_job([map_fn, value, emit_collector]() ->void{
@@ -0,0 +1,281 @@
+#pragma once
+#include "src/io/source.hpp"
+#include "src/io/sink.hpp"
+#include "src/internal/reduce.hpp"
+#include "src/thread/pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mr {
+
+template<typename Out_Type>
+using LessFn = std::function<bool(const Out_Type&, const Out_Type&)>;
+
+enum class OrderMode {
+  // Outputs are written to the sink in whatever order the reducers finish.
+  UNORDERED,
+  // Outputs are written to the sink in order of their reduce key, compared with key_less.
+  SORTED,
+  // Outputs are written to the sink sorted by less.
+  SORTED_BY_VALUE,
+  // Only the first k outputs according to less are written to the sink, in order.
+  TOP_K,
+};
+
+template<typename Key_Type, typename Out_Type>
+struct Ordering {
+  OrderMode mode = OrderMode::UNORDERED;
+  LessFn<Key_Type> key_less;
+  LessFn<Out_Type> less;
+  std::size_t k = 0;
+
+  static Ordering unordered() {
+    return Ordering();
+  }
+  static Ordering sorted(LessFn<Key_Type> key_less = std::less<Key_Type>()) {
+    return Ordering{OrderMode::SORTED, key_less, nullptr, 0};
+  }
+  static Ordering sorted_by_value(LessFn<Out_Type> less) {
+    return Ordering{OrderMode::SORTED_BY_VALUE, nullptr, less, 0};
+  }
+  // Pass a greater-than comparator to keep the k largest outputs.
+  static Ordering top_k(std::size_t k, LessFn<Out_Type> less) {
+    return Ordering{OrderMode::TOP_K, nullptr, less, k};
+  }
+};
+
+// Gives every thread writing to it its own T. The first call from a thread registers its
+// slot under a lock; after that the slot is found through a thread_local cache without locking.
+template<typename T>
+class PerThread {
+  // The last PerThread this thread used and its slot in it. Ids are never reused, so a
+  // cache entry can't point into a PerThread that has since been destroyed and reallocated.
+  struct Cache {
+    std::uint64_t owner = 0;
+    T* slot = nullptr;
+  };
+  static std::uint64_t next_id() {
+    static std::atomic<std::uint64_t> id{0};
+    return ++id;
+  }
+  const std::uint64_t id = next_id();
+  // References to values in an unordered_map stay valid when other threads insert.
+  std::unordered_map<std::thread::id, T> locals;
+  std::mutex mtx;
+public:
+  T& local() {
+    static thread_local Cache cache;
+    if(cache.owner == id) {
+      return *cache.slot;
+    }
+    std::lock_guard<std::mutex> lk(mtx);
+    T& slot = locals[std::this_thread::get_id()];
+    cache = Cache{id, &slot};
+    return slot;
+  }
+  // Must only be called once all writers are done.
+  std::vector<T*> all() {
+    std::lock_guard<std::mutex> lk(mtx);
+    std::vector<T*> out;
+    for(auto& local : locals) {
+      out.push_back(&local.second);
+    }
+    return out;
+  }
+};
+
+// Collects reduce outputs into per-thread runs and sorts them with a sample sort:
+// splitters are picked from a sample of every run, each run is range partitioned
+// on them and every partition is sorted on its own thread. flush_to then streams
+// the partitions out in order.
+template<typename Out_Type>
+class SampleSortCollector : public Sink<Out_Type> {
+  LessFn<Out_Type> less;
+  int n_threads;
+  PerThread<std::vector<Out_Type>> runs;
+
+  std::vector<Out_Type> pick_splitters(const std::vector<std::vector<Out_Type>*>& all_runs, std::size_t n_partitions) {
+    // Oversample so that partitions come out roughly even.
+    const std::size_t samples_per_run = 16 * n_partitions;
+    std::vector<Out_Type> samples;
+    for(const auto* run : all_runs) {
+      std::size_t n = std::min(samples_per_run, run->size());
+      for(std::size_t i = 0; i < n; i++) {
+        samples.push_back((*run)[i * run->size() / n]);
+      }
+    }
+    std::sort(samples.begin(), samples.end(), less);
+    std::vector<Out_Type> splitters;
+    for(std::size_t i = 1; i < n_partitions && !samples.empty(); i++) {
+      splitters.push_back(samples[i * samples.size() / n_partitions]);
+    }
+    return splitters;
+  }
+public:
+  SampleSortCollector(LessFn<Out_Type> less, int n_threads = 4) : less(less), n_threads(n_threads) {}
+  ~SampleSortCollector() {}
+  void write(const Out_Type& value) override {
+    runs.local().push_back(value);
+  }
+  // Flushes everything collected so far. Must only be called once all writers are done.
+  std::unique_ptr<Source<Out_Type>> to_source() override {
+    MemorySink<Out_Type> out;
+    flush(out);
+    return out.to_source();
+  }
+  // Writes everything collected so far to sink in sorted order. Must only be called once all writers are done.
+  void flush(Sink<Out_Type>& sink) {
+    flush_to([&sink](const Out_Type& value) -> void {
+      sink.write(value);
+    });
+  }
+  // Like flush, but hands every value to write instead of a sink.
+  template<typename Write_Fn>
+  void flush_to(Write_Fn write) {
+    std::vector<std::vector<Out_Type>*> all_runs = runs.all();
+    std::vector<Out_Type> splitters = pick_splitters(all_runs, n_threads);
+    const std::size_t n_partitions = splitters.size() + 1;
+
+    // buckets[r][p] holds the values of run r that belong to partition p.
+    std::vector<std::vector<std::vector<Out_Type>>> buckets(all_runs.size(), std::vector<std::vector<Out_Type>>(n_partitions));
+    {
+      thread::Pool pool(n_threads);
+      for(std::size_t r = 0; r < all_runs.size(); r++) {
+        pool.add_job([this, r, &all_runs, &buckets, &splitters]() -> void {
+          for(Out_Type& value : *all_runs[r]) {
+            std::size_t p = std::upper_bound(splitters.begin(), splitters.end(), value, less) - splitters.begin();
+            buckets[r][p].push_back(std::move(value));
+          }
+          std::vector<Out_Type>().swap(*all_runs[r]);
+        });
+      }
+    }
+
+    std::vector<std::vector<Out_Type>> partitions(n_partitions);
+    {
+      thread::Pool pool(n_threads);
+      for(std::size_t p = 0; p < n_partitions; p++) {
+        pool.add_job([this, p, &buckets, &partitions]() -> void {
+          std::vector<Out_Type>& partition = partitions[p];
+          for(auto& run_buckets : buckets) {
+            std::move(run_buckets[p].begin(), run_buckets[p].end(), std::back_inserter(partition));
+            std::vector<Out_Type>().swap(run_buckets[p]);
+          }
+          std::sort(partition.begin(), partition.end(), less);
+        });
+      }
+    }
+
+    for(auto& partition : partitions) {
+      for(const Out_Type& value : partition) {
+        write(value);
+      }
+      std::vector<Out_Type>().swap(partition);
+    }
+  }
+};
+
+// Keeps only the first k reduce outputs according to less. Every thread keeps its own
+// heap of at most k values, flush merges the heaps and writes the winners to the sink in order.
+template<typename Out_Type>
+class TopKCollector : public Sink<Out_Type> {
+  std::size_t k;
+  LessFn<Out_Type> less;
+  // Max-heaps by less, so the front is the value that gets evicted first.
+  PerThread<std::vector<Out_Type>> heaps;
+public:
+  TopKCollector(std::size_t k, LessFn<Out_Type> less) : k(k), less(less) {}
+  ~TopKCollector() {}
+  void write(const Out_Type& value) override {
+    if(k == 0) {
+      return;
+    }
+    std::vector<Out_Type>& heap = heaps.local();
+    if(heap.size() < k) {
+      heap.push_back(value);
+      std::push_heap(heap.begin(), heap.end(), less);
+    } else if(less(value, heap.front())) {
+      std::pop_heap(heap.begin(), heap.end(), less);
+      heap.back() = value;
+      std::push_heap(heap.begin(), heap.end(), less);
+    }
+  }
+  // Flushes everything collected so far. Must only be called once all writers are done.
+  std::unique_ptr<Source<Out_Type>> to_source() override {
+    MemorySink<Out_Type> out;
+    flush(out);
+    return out.to_source();
+  }
+  // Writes the top k values to sink in order. Must only be called once all writers are done.
+  void flush(Sink<Out_Type>& sink) {
+    std::vector<Out_Type> merged;
+    for(auto* heap : heaps.all()) {
+      std::move(heap->begin(), heap->end(), std::back_inserter(merged));
+      std::vector<Out_Type>().swap(*heap);
+    }
+    std::size_t n = std::min(k, merged.size());
+    std::partial_sort(merged.begin(), merged.begin() + n, merged.end(), less);
+    for(std::size_t i = 0; i < n; i++) {
+      sink.write(merged[i]);
+    }
+  }
+};
+
+// Throws on the calling thread, so a missing comparator doesn't surface as std::bad_function_call inside a pool worker.
+inline void check_less(bool has_less, const char* what) {
+  if(!has_less) {
+    std::cout << "exception: " << what << std::endl;
+    throw what;
+  }
+}
+
+// Apply the reduce operation and write its outputs to sink in the order asked for by ordering.
+template<typename Key_Type, typename Value_Type, typename Out_Type>
+void apply_ordered_reduce(Sink<Out_Type>& sink, KVSource<Key_Type, Value_Type>& src, const ReduceFn<Out_Type, Key_Type, Value_Type>& reduce_fn, const Ordering<Key_Type, Out_Type>& ordering, std::size_t max_queued_jobs) {
+  switch(ordering.mode) {
+  case OrderMode::UNORDERED:
+    apply_reduce(sink, src, reduce_fn, max_queued_jobs);
+    break;
+  case OrderMode::SORTED: {
+    check_less(static_cast<bool>(ordering.key_less), "Sorted ordering without a key comparator");
+    // Carry the reduce key along with each output so the outputs can be sorted by it.
+    using Keyed = std::pair<Key_Type, Out_Type>;
+    LessFn<Key_Type> key_less = ordering.key_less;
+    SampleSortCollector<Keyed> collector([key_less](const Keyed& a, const Keyed& b) -> bool {
+      return key_less(a.first, b.first);
+    });
+    ReduceFn<Keyed, Key_Type, Value_Type> keyed_reduce_fn = [&reduce_fn](const Key_Type& key, const std::vector<Value_Type>& values) -> Keyed {
+      return Keyed(key, reduce_fn(key, values));
+    };
+    apply_reduce(collector, src, keyed_reduce_fn, max_queued_jobs);
+    collector.flush_to([&sink](const Keyed& keyed) -> void {
+      sink.write(keyed.second);
+    });
+    break;
+  }
+  case OrderMode::SORTED_BY_VALUE: {
+    check_less(static_cast<bool>(ordering.less), "Sorted by value ordering without a comparator");
+    SampleSortCollector<Out_Type> collector(ordering.less);
+    apply_reduce(collector, src, reduce_fn, max_queued_jobs);
+    collector.flush(sink);
+    break;
+  }
+  case OrderMode::TOP_K: {
+    check_less(static_cast<bool>(ordering.less), "Top k ordering without a comparator");
+    TopKCollector<Out_Type> collector(ordering.k, ordering.less);
+    apply_reduce(collector, src, reduce_fn, max_queued_jobs);
+    collector.flush(sink);
+    break;
+  }
+  }
+}
+} // namespace mr
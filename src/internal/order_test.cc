@@ -0,0 +1,219 @@
+#include "order.hpp"
+#include "src/io/sink.hpp"
+#include "src/io/source.hpp"
+#include "src/thread/pool.hpp"
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+// Writes 0..n-1 shuffled into collector from several threads.
+void write_shuffled(mr::Sink<int>& collector, int n) {
+  mr::thread::Pool pool(4, 16);
+  for(int i = 0; i < n; i++) {
+    int value = (i * 7919) % n;
+    pool.add_job([&collector, value]() -> void {
+      collector.write(value);
+    });
+  }
+}
+
+// Sums the values of a key group.
+int sum_values(const int&, const std::vector<int>& values) {
+  int sum = 0;
+  for(int v : values) {
+    sum += v;
+  }
+  return sum;
+}
+
+// Runs apply_ordered_reduce over keys 0..n-1, each with the values {key, key}.
+std::vector<int> reduce_ordered(int n, const mr::ReduceFn<int, int, int>& reduce_fn, const mr::Ordering<int, int>& ordering) {
+  std::unordered_map<int, std::vector<int>> groups;
+  for(int i = 0; i < n; i++) {
+    groups[i] = {i, i};
+  }
+  mr::MemoryKVSource<int, int> src(groups);
+  mr::MemorySink<int> sink;
+  mr::apply_ordered_reduce(sink, src, reduce_fn, ordering, 16);
+  return sink.get_data();
+}
+
+bool test_reduce_unordered_by_default() {
+  const int n = 1000;
+  mr::Ordering<int, int> ordering;
+  if(ordering.mode != mr::OrderMode::UNORDERED) {
+    std::cout << "Expected the default ordering to be unordered" << std::endl;
+    return false;
+  }
+  std::vector<int> data = reduce_ordered(n, sum_values, ordering);
+  std::sort(data.begin(), data.end());
+  if(data.size() != n) {
+    std::cout << "Expected " << n << " reduced values, got: " << data.size() << std::endl;
+    return false;
+  }
+  for(int i = 0; i < n; i++) {
+    if(data[i] != 2 * i) {
+      std::cout << "Expected " << 2 * i << " among the reduced values, got: " << data[i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_reduce_sorted_by_key() {
+  // The outputs decrease as the keys increase, so only key order puts them in this order.
+  const int n = 1000;
+  mr::ReduceFn<int, int, int> negate = [](const int& key, const std::vector<int>&) -> int {
+    return -key;
+  };
+  std::vector<int> data = reduce_ordered(n, negate, mr::Ordering<int, int>::sorted());
+  if(data.size() != n) {
+    std::cout << "Expected " << n << " reduced values, got: " << data.size() << std::endl;
+    return false;
+  }
+  for(int i = 0; i < n; i++) {
+    if(data[i] != -i) {
+      std::cout << "Expected " << -i << " at position " << i << ", got: " << data[i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_reduce_sorted_by_value() {
+  const int n = 1000;
+  std::vector<int> data = reduce_ordered(n, sum_values, mr::Ordering<int, int>::sorted_by_value([](const int& a, const int& b) -> bool { return a < b; }));
+  if(data.size() != n) {
+    std::cout << "Expected " << n << " reduced values, got: " << data.size() << std::endl;
+    return false;
+  }
+  for(int i = 0; i < n; i++) {
+    if(data[i] != 2 * i) {
+      std::cout << "Expected " << 2 * i << " at position " << i << ", got: " << data[i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_reduce_top_k() {
+  const int n = 1000;
+  std::vector<int> data = reduce_ordered(n, sum_values, mr::Ordering<int, int>::top_k(10, [](const int& a, const int& b) -> bool { return a > b; }));
+  if(data.size() != 10) {
+    std::cout << "Expected 10 reduced values, got: " << data.size() << std::endl;
+    return false;
+  }
+  for(int i = 0; i < 10; i++) {
+    if(data[i] != 2 * (n - 1 - i)) {
+      std::cout << "Expected " << 2 * (n - 1 - i) << " at position " << i << ", got: " << data[i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_reduce_without_comparator_throws() {
+  try {
+    reduce_ordered(10, sum_values, mr::Ordering<int, int>::top_k(3, nullptr));
+  } catch(const char*) {
+    return true;
+  }
+  std::cout << "Expected a top k ordering without a comparator to throw" << std::endl;
+  return false;
+}
+
+bool test_collector_to_source() {
+  mr::TopKCollector<int> collector(3, [](const int& a, const int& b) -> bool { return a < b; });
+  write_shuffled(collector, 100);
+  std::unique_ptr<mr::Source<int>> src = collector.to_source();
+  for(int i = 0; i < 3; i++) {
+    if(!src->has_next()) {
+      std::cout << "Expected 3 values from to_source, got: " << i << std::endl;
+      return false;
+    }
+    int value = src->next();
+    if(value != i) {
+      std::cout << "Expected " << i << " from to_source, got: " << value << std::endl;
+      return false;
+    }
+  }
+  return !src->has_next();
+}
+
+bool test_sample_sort() {
+  const int n = 10007;
+  mr::SampleSortCollector<int> collector([](const int& a, const int& b) -> bool { return a < b; });
+  write_shuffled(collector, n);
+  mr::MemorySink<int> sink;
+  collector.flush(sink);
+  const std::vector<int>& data = sink.get_data();
+  if(data.size() != n) {
+    std::cout << "Expected " << n << " sorted values, got: " << data.size() << std::endl;
+    return false;
+  }
+  for(int i = 0; i < n; i++) {
+    if(data[i] != i) {
+      std::cout << "Expected " << i << " at position " << i << ", got: " << data[i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_top_k() {
+  const int n = 10007;
+  mr::TopKCollector<int> collector(100, [](const int& a, const int& b) -> bool { return a > b; });
+  write_shuffled(collector, n);
+  mr::MemorySink<int> sink;
+  collector.flush(sink);
+  const std::vector<int>& data = sink.get_data();
+  if(data.size() != 100) {
+    std::cout << "Expected 100 values, got: " << data.size() << std::endl;
+    return false;
+  }
+  for(int i = 0; i < 100; i++) {
+    if(data[i] != n - 1 - i) {
+      std::cout << "Expected " << n - 1 - i << " at position " << i << ", got: " << data[i] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main() {
+  if(!test_sample_sort()) {
+    std::cout << "Sample sort failed!" << std::endl;
+    return -1;
+  }
+  if(!test_top_k()) {
+    std::cout << "Top k failed!" << std::endl;
+    return -1;
+  }
+  if(!test_reduce_unordered_by_default()) {
+    std::cout << "Unordered reduce failed!" << std::endl;
+    return -1;
+  }
+  if(!test_reduce_sorted_by_key()) {
+    std::cout << "Sorted by key reduce failed!" << std::endl;
+    return -1;
+  }
+  if(!test_reduce_sorted_by_value()) {
+    std::cout << "Sorted by value reduce failed!" << std::endl;
+    return -1;
+  }
+  if(!test_reduce_top_k()) {
+    std::cout << "Top k reduce failed!" << std::endl;
+    return -1;
+  }
+  if(!test_reduce_without_comparator_throws()) {
+    std::cout << "Missing comparator check failed!" << std::endl;
+    return -1;
+  }
+  if(!test_collector_to_source()) {
+    std::cout << "Collector to_source failed!" << std::endl;
+    return -1;
+  }
+  std::cout << "Success" << std::endl;
+}
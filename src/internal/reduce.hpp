@@ -8,12 +8,15 @@ namespace mr {
 template<typename Out_Type, typename Key_Type, typename Value_Type>
 using ReduceFn = std::function<Out_Type(const Key_Type&, const std::vector<Value_Type>&)>;
 
+// Apply the reduce operation to every key group of a source.
+// At most max_queued_jobs key groups wait in the pool at any time. This only bounds the
+// pool's pending copies: the source may hold more, e.g. KVFileSource loads a whole shard.
 template<typename Key_Type, typename Value_Type, typename Out_Type>
-void apply_reduce(Sink<Out_Type>& sink, KVSource<Key_Type, Value_Type>& src, const ReduceFn<Out_Type, Key_Type, Value_Type>& reduce_fn) {
-  thread::Pool pool(4);
+void apply_reduce(Sink<Out_Type>& sink, KVSource<Key_Type, Value_Type>& src, const ReduceFn<Out_Type, Key_Type, Value_Type>& reduce_fn, std::size_t max_queued_jobs) {
+  thread::Pool pool(4, max_queued_jobs);
   while(src.has_next()) {
-    const auto& value = src.next();
-    pool.add_job([value, &sink, reduce_fn]() ->void{
+    auto value = src.next();
+    pool.add_job([value = std::move(value), &sink, reduce_fn]() ->void{
       const Out_Type& out = reduce_fn(value.first, value.second);
       sink.write(out);
     });
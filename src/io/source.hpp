@@ -158,9 +158,14 @@ public:
     this->data = data;
     data_it = this->data.begin();
   }
+  void set_data(std::unordered_map<Key_Type, std::vector<Value_Type>>&& data) {
+    this->data = std::move(data);
+    data_it = this->data.begin();
+  }
   std::pair<Key_Type, std::vector<Value_Type>> next() override {
     std::lock_guard<std::mutex> lk(mtx);
-    auto data = *data_it;
+    // Every key group is handed out once, so move its values out instead of copying them.
+    std::pair<Key_Type, std::vector<Value_Type>> data(data_it->first, std::move(data_it->second));
     ++data_it;
     return data;
   }
@@ -179,15 +184,16 @@ struct KV {
 template<typename Key_Type, typename Value_Type>
 class KVFileSource : public KVSource<Key_Type, Value_Type> {
   StreamingFileSource<KV<Key_Type, Value_Type>> streaming_source;
-  std::unordered_map<Key_Type, std::vector<Value_Type>> data;
   MemoryKVSource<Key_Type, Value_Type> source;
 public:
+  // Loads the whole file into memory, grouped by key.
   KVFileSource(FILE* file, std::size_t buffer_size, std::function<KV<Key_Type, Value_Type>(const std::string&)> decoder) : streaming_source(file, buffer_size, decoder) {
+    std::unordered_map<Key_Type, std::vector<Value_Type>> data;
     while(streaming_source.has_next()) {
       KV kv = streaming_source.next();
       data[kv.key].push_back(kv.value);
     }
-    source.set_data(data);
+    source.set_data(std::move(data));
   }
 
   bool has_next() override {
@@ -1,6 +1,7 @@
 #pragma once
 #include "io/source.hpp"
 #include "internal/map.hpp"
+#include "internal/order.hpp"
 #include "internal/reduce.hpp"
 #include "thread/pool.hpp"
 
@@ -26,20 +27,28 @@ namespace mr
     Sink<Out_Type> &sink;
     const MapFn<In_Type, Map_Key_Type, Map_Value_Type> &map_fn;
     const ReduceFn<Out_Type, Map_Key_Type, Map_Value_Type> &reduce_fn;
+    // Depth of the job queue in the map and reduce phases, bounds how much input is held in memory at once.
+    std::size_t max_queued_jobs;
+    Ordering<Map_Key_Type, Out_Type> ordering;
 
   public:
     // TODO: Initialize the thread pool to use the number of threads we have cores.
-    MapReduce(Source<In_Type> &src, Sink<Out_Type> &sink, const MapFn<In_Type, Map_Key_Type, Map_Value_Type> &map_fn, const ReduceFn<Out_Type, Map_Key_Type, Map_Value_Type> &reduce_fn) : src(src), sink(sink), map_fn(map_fn), reduce_fn(reduce_fn) {}
+    MapReduce(Source<In_Type> &src, Sink<Out_Type> &sink, const MapFn<In_Type, Map_Key_Type, Map_Value_Type> &map_fn, const ReduceFn<Out_Type, Map_Key_Type, Map_Value_Type> &reduce_fn, std::size_t max_queued_jobs = thread::DEFAULT_MAX_QUEUED_JOBS) : src(src), sink(sink), map_fn(map_fn), reduce_fn(reduce_fn), max_queued_jobs(max_queued_jobs) {}
+    // Controls the order reduce outputs are written to the sink in, see Ordering.
+    void set_ordering(const Ordering<Map_Key_Type, Out_Type> &ordering)
+    {
+      this->ordering = ordering;
+    }
     void run(std::size_t buffer_size, std::function<std::size_t(const Map_Key_Type &)> hasher, std::function<std::string(const Map_Key_Type &, const Map_Value_Type &)> encoder, std::function<KV<Map_Key_Type, Map_Value_Type>(const std::string &)> decoder)
     {
       // std::function<ShardedKVFileSource::KV(const std::string&)> decoder
       std::vector<std::string> shards = generate_shards(10, "intermediate_kv_", "/home/jovi/Programming/map_reduce_cpp/tmp");
       ShardedKVFileSink<Map_Key_Type, Map_Value_Type> apply_sink(shards, hasher, encoder);
       //MemoryKVSink<Map_Key_Type, Map_Value_Type> apply_sink;
-      apply_map(src, apply_sink, map_fn);
+      apply_map(src, apply_sink, map_fn, max_queued_jobs);
       // Remap the sink to a source.
       auto apply_src = apply_sink.to_source(buffer_size, decoder);
-      apply_reduce(sink, *apply_src, reduce_fn);
+      apply_ordered_reduce(sink, *apply_src, reduce_fn, ordering, max_queued_jobs);
     }
   };
 } // namespace mr
\ No newline at end of file
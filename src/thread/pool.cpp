@@ -4,7 +4,7 @@
 
 namespace mr {
 namespace thread {
-Pool::Pool(int n_threads) {
+Pool::Pool(int n_threads, std::size_t max_queued_jobs) : max_queued_jobs(max_queued_jobs > 0 ? max_queued_jobs : 1) {
 // std::thread t(&Pool::run_worker, this);
   for(int i = 0; i < n_threads; i++) {
     threads.emplace_back(&Pool::run_worker, this);
@@ -12,28 +12,32 @@ Pool::Pool(int n_threads) {
 }
 
 Pool::~Pool() {
-  should_quit.store(true);
+  {
+    std::lock_guard<std::mutex> lk(job_queue_lock);
+    should_quit.store(true);
+  }
+  queue_var.notify_all();
   for(std::thread& t : threads) {
     t.join();
   }
+  while(!jobs.empty()) {
+    auto job = std::move(jobs.front());
+    jobs.pop();
+    job();
+  }
 }
 
 void Pool::run_worker() {
-  while(!jobs.empty() || !this->should_quit.load()) {
-    // TODO: Add predicate that checks if the thread should be shut down.
+  while(true) {
     std::unique_lock<std::mutex> lk(job_queue_lock);
+    queue_var.wait(lk, [this]() -> bool {
+      return !jobs.empty() || should_quit.load();
+    });
     if(jobs.empty()) {
-      queue_var.wait_for(lk, std::chrono::milliseconds(100));
-    }
-    if(!lk.owns_lock()) {
-      continue;
-    }
-    
-    // There's a job available! Take it and run!
-    if(jobs.empty()) {
-      // Someone else took the job.
+      // Asked to quit and there is nothing left to run.
       return;
     }
+    // There's a job available! Take it and run!
     auto job = std::move(jobs.front());
     jobs.pop();
     lk.unlock();
@@ -42,11 +46,18 @@ void Pool::run_worker() {
 }
 
 void Pool::add_job(std::function<void()> f) {
-  {
-    std::lock_guard<std::mutex> lk(job_queue_lock);
-    jobs.push(f);
+  std::unique_lock<std::mutex> lk(job_queue_lock);
+  while(jobs.size() >= max_queued_jobs) {
+    // The queue is full. Instead of waiting for a worker, run the oldest job on this thread.
+    auto job = std::move(jobs.front());
+    jobs.pop();
+    lk.unlock();
+    job();
+    lk.lock();
   }
+  jobs.push(std::move(f));
+  lk.unlock();
   queue_var.notify_one();
 }
 }
-}
\ No newline at end of file
+}
@@ -8,19 +8,29 @@
 
 namespace mr {
 namespace thread {
+// Default depth of a Pool's job queue.
+constexpr std::size_t DEFAULT_MAX_QUEUED_JOBS = 1024;
+
 class Pool {
-// A thread pool.
+// A thread pool with a bounded job queue.
   std::mutex job_queue_lock;
   std::condition_variable queue_var;
-  std::atomic<bool> should_quit;
+  std::atomic<bool> should_quit{false};
   std::queue<std::function<void()>> jobs;
+  // Maximum number of jobs waiting in the queue. Producers never grow the queue past this.
+  // A max_queued_jobs of 0 is clamped to 1.
+  const std::size_t max_queued_jobs;
   std::vector<std::thread> threads;
   void run_worker();
 public:
-  Pool(int n_threads);
+  Pool(int n_threads, std::size_t max_queued_jobs = DEFAULT_MAX_QUEUED_JOBS);
   // Wait until the thread pool is empty of jobs and join the threads.
+  // Jobs still queued after the workers are gone (e.g. with no workers) are run on the calling thread.
   ~Pool();
+  // Adds a job to the queue. If the queue is full the calling thread helps out by
+  // running the oldest queued job itself until there is room, so memory held by
+  // pending jobs is bounded by max_queued_jobs rather than by the producer's input.
   void add_job(std::function<void()> f);
 };
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,57 @@
+#include "pool.hpp"
+#include <iostream>
+#include <atomic>
+
+namespace {
+bool test_runs_all_jobs() {
+  std::atomic<int> n_run{0};
+  {
+    mr::thread::Pool pool(4, 8);
+    for(int i = 0; i < 1000; i++) {
+      pool.add_job([&n_run]() -> void {
+        n_run++;
+      });
+    }
+  }
+  if(n_run.load() != 1000) {
+    std::cout << "Expected 1000 jobs to run, ran: " << n_run.load() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool test_queue_is_bounded() {
+  // Without workers nothing drains the queue, so the producer has to run everything past the bound itself.
+  std::atomic<int> n_run{0};
+  {
+    mr::thread::Pool pool(0, 2);
+    for(int i = 0; i < 10; i++) {
+      pool.add_job([&n_run]() -> void {
+        n_run++;
+      });
+    }
+    if(n_run.load() != 8) {
+      std::cout << "Expected the producer to run 8 jobs, ran: " << n_run.load() << std::endl;
+      return false;
+    }
+  }
+  // The remaining queued jobs are run when the pool is destroyed.
+  if(n_run.load() != 10) {
+    std::cout << "Expected 10 jobs to run, ran: " << n_run.load() << std::endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int main() {
+  if(!test_runs_all_jobs()) {
+    std::cout << "Pool did not run all jobs!" << std::endl;
+    return -1;
+  }
+  if(!test_queue_is_bounded()) {
+    std::cout << "Pool queue was not bounded!" << std::endl;
+    return -1;
+  }
+  std::cout << "Success" << std::endl;
+}